@@ -4,9 +4,12 @@ Functional tests for Dining Philosophers simulation.
 Requires compiled binary at ./bin/diningPhilosophers
 """
 
+import signal
 import subprocess
+import struct
 import sys
 import re
+import time
 import pytest
 
 # pytest documentation ref: https://docs.pytest.org/en/stable/how-to/usage.html
@@ -106,15 +109,165 @@ def test_varied_philosopher_values(count):
 
     print("PASSED: philosopher was taken as input")
 
-@pytest.mark.parametrize("flags", [["--duration", "abc"], ["--philosophers", "abc"]])
+@pytest.mark.parametrize("flags", [["--duration", "abc"], ["--philosophers", "abc"], ["--retain-meals", "-1"],
+                                   ["--think", "exp:abc"], ["--think", "exp:nan"], ["--eat", "weibull:1,2"], ["--eat", "uniform:0,inf"], ["--trace", "/nonexistent/trace"],
+                                   ["--max-philosophers", "abc"], ["--philosophers", "5", "--max-philosophers", "3"]])
 def test_invalid_flag_strings(flags):
     """ Parametrized test that we can pass multiple types of flags and the binary handles non-numeric values """
     rc, output, err = run_simulation(extra_args=flags, timeout=5)
 
     assert rc != 0
-    assert re.search(r"(Invalid duration value:|Invalid philosopher value:)", err)
+    assert re.search(r"Invalid (duration|philosopher|max-philosophers|retain-meals|think|eat|trace) value:", err)
     print("PASSED: handled incorrect inputs")
 
+def test_resize_running_ring():
+    """ Test that SIGUSR1/SIGUSR2 grow and shrink a running ring within --max-philosophers and down to two """
+    process = subprocess.Popen([BINARY, "--duration", "8", "--philosophers", "3", "--max-philosophers", "5",
+                                "--think", "uniform:20,100", "--eat", "uniform:10,50"],
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    # Pending signals of one kind don't queue, so give each one time to be handled
+    time.sleep(1)
+    for _ in range(3): # the third finds no free seat
+        process.send_signal(signal.SIGUSR1)
+        time.sleep(0.5)
+    time.sleep(1)
+    for _ in range(4): # the fourth would leave one philosopher
+        process.send_signal(signal.SIGUSR2)
+        time.sleep(0.5)
+
+    try:
+        stdout, stderr = process.communicate(timeout=15)
+    except subprocess.TimeoutExpired:
+        process.kill()
+        pytest.fail("Simulation didn't stop after being resized")
+    output = stdout.decode()
+    err = stderr.decode()
+
+    assert process.returncode == 0
+    for i in (3, 4):
+        assert re.search(f"Philosopher {i} joins the table", output), f"Philosopher {i} was never seated"
+        assert re.search(f"Philosopher {i} starts eating", output), f"Philosopher {i} never ate"
+    assert re.search(r"no free seat", err)
+    for i in (4, 3, 2):
+        assert re.search(f"Philosopher {i} leaves the table", output), f"Philosopher {i} never left"
+    assert re.search(r"could not remove a philosopher", err)
+    assert not re.search(r"GROSS! \(violation\)", output)
+    print("PASSED: ring grew and shrank while running")
+
+def test_hashi_retention():
+    """ Test that keeping hashi across meals still feeds everyone and never lets neighbors eat together """
+    rc, output, err = run_simulation(extra_args=["--duration", "10", "--philosophers", "3", "--retain-meals", "3"], timeout=15)
+
+    assert rc == 0
+    for i in range(3):
+        assert re.search(f"Philosopher {i} starts eating", output), f"Philosopher {i} never ate"
+    assert not re.search(r"GROSS! \(violation\)", output)
+    print("PASSED: hashi retention ran without violations")
+
+def test_hashi_retention_at_low_contention():
+    """ Test that hashi actually get kept when neighbors aren't hungry, and never for more than --retain-meals meals """
+    RETAIN_MEALS = 2
+    # Long, spread out thinking and quick meals keep neighbors from being hungry most of the time
+    rc, output, err = run_simulation(extra_args=["--duration", "10", "--philosophers", "6", "--retain-meals", str(RETAIN_MEALS),
+                                                 "--think", "exp:800", "--eat", "uniform:5,10"], timeout=15)
+
+    assert rc == 0
+    assert re.search(r"keeps their hashi for another meal", output), "Hashi were never retained"
+
+    # A "starts eating" right after our own "keeps their hashi" line is another meal on the same pickup
+    streak = {}
+    kept = {}
+    for line in output.splitlines():
+        match = re.match(r"Philosopher (\d+) (starts eating|keeps their hashi)", line)
+        if not match:
+            continue
+        philosopher_id, event = match.groups()
+        if event == "keeps their hashi":
+            kept[philosopher_id] = True
+        else:
+            streak[philosopher_id] = streak.get(philosopher_id, 0) + 1 if kept.get(philosopher_id) else 1
+            kept[philosopher_id] = False
+            assert streak[philosopher_id] <= RETAIN_MEALS, \
+                f"Philosopher {philosopher_id} ate {streak[philosopher_id]} meals in a row on the same hashi"
+    print("PASSED: hashi were retained, within the cap")
+
+@pytest.mark.slow # skip with -m "not slow"
+def test_hashi_retention_keeps_throughput():
+    """ Test that retaining hashi at low contention doesn't cost meals, a hungry neighbor gets them handed over instead of backing off """
+    meals = {}
+    for retain_meals in (0, 3):
+        rc, output, err = run_simulation(extra_args=["--duration", "15", "--philosophers", "12", "--retain-meals", str(retain_meals),
+                                                     "--think", "exp:800", "--eat", "uniform:5,10"], timeout=20)
+        assert rc == 0
+        summary = re.search(r"Hunger latency .* meals (\d+)", output)
+        assert summary
+        meals[retain_meals] = int(summary.group(1))
+
+    print(f"Meals in 15s, retention off: {meals[0]}, on: {meals[3]}")
+    # Meals are random, so allow for noise, losing a hungry neighbor's attempt costs ~20%
+    assert meals[3] >= 0.9 * meals[0], f"Retention cost throughput: {meals[3]} meals vs {meals[0]} without"
+    print("PASSED: retention kept up with no retention")
+
+def test_fair_mode():
+    """ Test that fair mode feeds everyone without ever forcing a meal, and reports its hunger latency """
+    rc, output, err = run_simulation(extra_args=["--duration", "10", "--philosophers", "7", "--fair"], timeout=15)
+
+    assert rc == 0
+    for i in range(7):
+        assert re.search(f"Philosopher {i} starts eating", output), f"Philosopher {i} never ate"
+    assert not re.search(r"is being forced to eat", output)
+    assert not re.search(r"GROSS! \(violation\)", output)
+    summary = re.search(r"Hunger latency \(fair policy, ms\): p50 \d+, p99 \d+, p99\.9 \d+, max \d+, most neighbor meals skipped (\d+)", output)
+    assert summary
+    assert int(summary.group(1)) <= 2, "A hungry philosopher sat through more than one meal per neighbor"
+    print("PASSED: fair mode ran without forced meals")
+
+def test_summary_counts_every_meal():
+    """ Test that the summary's meal count includes forced meals, which don't log "starts eating" """
+    rc, output, err = run_simulation(extra_args=["--duration", "10", "--philosophers", "7"], timeout=15)
+
+    assert rc == 0
+    summary = re.search(r"Hunger latency \(forced-eat policy, ms\):.*, meals (\d+)", output)
+    assert summary
+    logged = len(re.findall(r"starts eating", output)) + len(re.findall(r"is being forced to eat", output))
+    assert int(summary.group(1)) == logged
+    print(f"PASSED: summary counted all {logged} meals")
+
+# WORKLOAD TESTS #
+@pytest.mark.parametrize("flags", [["--think", "exp:300", "--eat", "lognormal:5.5,0.5"],
+                                   ["--think", "pareto:200,1.5", "--eat", "uniform:100,400", "--backoff", "exp:30"]])
+def test_workload_distributions(flags):
+    """ Parametrized test that the simulation runs cleanly with non-uniform timing distributions """
+    rc, output, err = run_simulation(extra_args=["--duration", "5"] + flags, timeout=10)
+
+    assert rc == 0
+    assert re.search(r"starts eating", output)
+    assert not re.search(r"GROSS! \(violation\)", output)
+    print("PASSED: ran with distributions " + " ".join(flags))
+
+def test_long_samples_dont_delay_shutdown():
+    """ Test that a 20 second think time is cut short when the run ends """
+    rc, output, err = run_simulation(extra_args=["--duration", "1", "--think", "uniform:20000,20001"], timeout=5)
+
+    assert rc == 0
+    print("PASSED: exited without waiting out the think time")
+
+def test_workload_histogram_and_trace(tmp_path):
+    """ Test that an empirical histogram and a replayed timing trace drive the simulation """
+    histogram = tmp_path / "think.hist"
+    histogram.write_text("100 5\n400 2\n1500 1\n")
+
+    # 5 philosophers, 20 short (think_ms, eat_ms) records each
+    trace = tmp_path / "timing.trace"
+    trace.write_bytes(b"".join(struct.pack("=II", 50 + i % 7, 100 + i % 11) for i in range(100)))
+
+    rc, output, err = run_simulation(extra_args=["--duration", "5", "--backoff", f"hist:{histogram}", "--trace", str(trace)], timeout=10)
+
+    assert rc == 0
+    for i in range(NUM_PHILOSOPHERS):
+        assert re.search(f"Philosopher {i} starts eating", output), f"Philosopher {i} never ate"
+    print("PASSED: replayed histogram and trace workload")
+
 # REQUIREMENT/Deadlock/Livelock/Starvation type TESTS #
 @pytest.mark.slow # skip with -m "not slow"
 def test_detecting_starvation_warning_and_handling():
@@ -234,6 +387,11 @@ def main():
     test_unknown_flag_errors()
     test_varied_philosopher_values()
     test_invalid_flag_strings()
+    test_resize_running_ring()
+    test_hashi_retention()
+    test_hashi_retention_at_low_contention()
+    test_fair_mode()
+    test_summary_counts_every_meal()
     test_detecting_starvation_warning_and_handling()
     test_detecting_deadlock_and_violation_print()
     test_large_number_of_philosophers()
@@ -4,6 +4,8 @@
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdarg.h> // need this for the `...` variable number of arguments in safe_printf's signature
 
 /*============== TYPEDEFS ==============*/
@@ -19,28 +21,96 @@ typedef enum {
     VIOLATION = 1
 } violation_detection_t;
 
+/** Timing distributions a workload can draw think/eat/backoff times from */
+typedef enum {
+    DIST_UNIFORM = 0,       // a = min ms, b = max ms (exclusive)
+    DIST_EXPONENTIAL = 1,   // a = mean ms
+    DIST_LOGNORMAL = 2,     // a = mu, b = sigma of the underlying normal (of ln(ms))
+    DIST_PARETO = 3,        // a = scale (minimum) ms, b = shape alpha
+    DIST_HISTOGRAM = 4      // empirical: histogram_ms values picked with histogram_cdf weights
+} distribution_kind_t;
+
+/** One timing distribution, parsed from a spec string like "exp:800" (see parse_distribution) */
+typedef struct {
+    distribution_kind_t kind;
+    double a;
+    double b;
+    int histogram_size;
+    int *histogram_ms;          // bucket values in ms (malloc'd, DIST_HISTOGRAM only)
+    double *histogram_cdf;      // running total of the bucket weights, normalized to 1.0
+} distribution_t;
+
+/** Where think/eat/backoff times come from. A loaded trace replaces the think and eat distributions. */
+typedef struct {
+    distribution_t think;
+    distribution_t eat;
+    distribution_t backoff;
+    const uint32_t *trace;      // mmap'd (think_ms, eat_ms) uint32 pairs, NULL when not replaying a trace
+    size_t trace_records;       // number of pairs in the trace
+    size_t trace_bytes;         // mapped length, for munmap
+} workload_t;
+
+/** Samples are drawn WORKLOAD_BATCH at a time so the hot path only bumps an index */
+#define WORKLOAD_BATCH 64
+/** Cap on a single sample (keeps sleep_ms in int range). Philosophers sleep in short slices, so stopping never waits on a sample. */
+#define WORKLOAD_MAX_MS 60000
+
+/** Hunger latency (first attempt to first bite) is recorded in HUNGER_BUCKET_MS buckets, the last one catches everything longer */
+#define HUNGER_BUCKET_MS 10
+#define HUNGER_BUCKETS (WORKLOAD_MAX_MS / HUNGER_BUCKET_MS + 1)
+
+typedef struct {
+    int samples[WORKLOAD_BATCH];
+    int next;                   // next unread sample, WORKLOAD_BATCH when empty
+} sample_batch_t;
+
 // forward declaration
 typedef struct simulation simulation_t;
 
 /** Philosopher struct encapsulates each thread's info */
-typedef struct {
-    int id;                                     // logging and easy identification
-    pthread_mutex_t *left_hashi;                // keep left mutex
-    pthread_mutex_t *right_hashi;               // keep right mutex
+typedef struct philosopher philosopher_t;
+struct philosopher {
+    int id;                                     // logging and easy identification (also the seat index into hashi/philosophers)
+    pthread_mutex_t *left_hashi;                // keep left mutex (always our own seat's hashi, never changes)
+    pthread_mutex_t *_Atomic right_hashi;       // keep right mutex (swapped by add/remove_philosopher when our right neighbor changes)
+    philosopher_t *_Atomic left_neighbor;       // neighbor seats for the violation check, also swapped on resize
+    philosopher_t *_Atomic right_neighbor;
     _Atomic philosopher_state_t state;          // philosopher state used in testing mainly. can be checked by other threads, so atomic
     violation_detection_t violation_flag;       // violation detection flag for if eating while neighbor is eating
     int starvation_counter;                     // number of cycles without eating
+    int longest_meal_streak;                    // most meals eaten on one pickup of the hashi (> 1 only with retain_meals), owner thread only
+    atomic_bool retaining;                      // sitting on our hashi between retained meals, a hungry neighbor can wait for the handoff
+    atomic_bool hungry;                         // announced when we start trying to eat, cleared after a meal (neighbors holding our hashi yield to it)
+    _Atomic long hunger_ticket;                 // taken from sim->next_hunger_ticket when this hunger started, lower tickets go first in fair mode
+    _Atomic long hungry_since_ms;               // monotonic ms when this hunger started, only for the latency histogram
+    atomic_int meals_skipped;                   // neighbor meals started during our current hunger (bumped by the neighbors)
+    int most_meals_skipped;                     // worst meals_skipped over the run (fair mode keeps it <= 2), owner thread only
+    bool seated;                                // seat is in the ring (only touched under resize_mutex once the simulation runs)
+    atomic_bool leaving;                        // asks this philosopher's thread to leave the table (remove_philosopher)
+    uint64_t rng_state;                         // per-thread xorshift state, so sampling doesn't contend on rand()'s lock
+    sample_batch_t think_batch;                 // pre-generated think/eat/backoff times, only touched by the owning thread
+    sample_batch_t eat_batch;
+    sample_batch_t backoff_batch;
+    size_t trace_next;                          // meal cycles replayed from the trace, the current (think_ms, eat_ms) record is ours after that many
     pthread_t thread_id;                        // thread identifier (don't use for math/only use for thread starting/joining etc.)
     simulation_t *sim;                          // points back to the overall simulation context
-} philosopher_t;
+};
 
 /** Simulation context -- full encapsulation, no global variables in this version */
 struct simulation {
-    int num_philosophers;
+    int num_philosophers;    // philosophers currently seated (changes with add/remove_philosopher)
+    int max_philosophers;    // seats allocated in the hashi and philosophers arrays, must be >= num_philosophers
+    int retain_meals;        // 0 disables hashi retention, otherwise the max consecutive meals on the same hashi while no neighbor is hungry
+    const workload_t *workload; // timing distributions/trace, NULL uses the default uniform 500-1500 ms think/eat and 50-150 ms backoff
+    bool fair_mode;          // hungry philosophers defer to older hungry neighbors instead of the blocking forced-eat checkpoint
+    atomic_long next_hunger_ticket; // strictly increasing hunger tickets, so no two hungers ever tie (reset by start_simulation)
+    _Atomic unsigned long hunger_histogram[HUNGER_BUCKETS]; // hunger latencies of every meal this run, retained meals as 0 ms (reset by start_simulation)
     philosopher_t *philosophers;
     pthread_mutex_t *hashi;
     atomic_bool stop_flag;   // atomic for cross-thread safety
     pthread_mutex_t thread_safe_print_mutex;
+    pthread_mutex_t resize_mutex; // serializes add/remove_philosopher against each other and the final join (philosophers never take it)
+    bool running;            // philosopher threads are up and not joined yet (guarded by resize_mutex)
 };
 
 /*============== MAIN ROUTINES ==============*/
@@ -52,6 +122,15 @@ struct simulation {
  * Each philosopher alternates between thinking and trying to eat.
  * Eating requires acquiring both left and right hashi (mutexes).
  * If a philosopher is unable to acquire both, they will release their held hashi, and will retry at a later time.
+ * With sim->retain_meals set, a philosopher keeps their hashi through thinking and eats again (up to retain_meals meals)
+ * as long as neither neighbor is hungry, putting them down as soon as one is.
+ *
+ * Default policy: after 10 failed attempts a starving philosopher blocks on both hashi and is forced to eat.
+ * Fair mode (sim->fair_mode): no forced meals. A hungry philosopher with a neighbor whose hunger ticket is older
+ * (lower, tickets are unique) doesn't reach for the hashi, and retries after a backoff instead of thinking again.
+ * Tickets are only renewed after eating, so once P is hungry each neighbor starts at most one more meal before P eats:
+ * P never skips more than two consecutive neighbor meals. The oldest hungry philosopher in the ring never defers,
+ * so the deferrals can't form a cycle.
  */
 void *philosopher_routine(void *arg);
 /**
@@ -77,7 +156,29 @@ void safe_printf(simulation_t *sim, const char *format, ...);
  */
 void sleep_ms(int millisec);
 /**
- * @brief Initialize all mutexes
+ * @brief Next think time for a philosopher, from their pre-generated batch (refilled from the workload when empty)
+ * With a trace this is the think time of the current record, which stays current until next_eat_ms,
+ * so thinking again after a failed attempt doesn't use up records
+ * @param p Pointer to the philosopher, must be called from that philosopher's own thread
+ * @return int: milliseconds to think for
+ */
+int next_think_ms(philosopher_t *p);
+/**
+ * @brief Next eat time for a philosopher, see next_think_ms
+ * With a trace this is the eat time of the same record as the think before it, and the meal cycle moves on to the next record
+ * @param p Pointer to the philosopher
+ * @return int: milliseconds to eat for
+ */
+int next_eat_ms(philosopher_t *p);
+/**
+ * @brief Next backoff time (delay between attempts) for a philosopher, see next_think_ms
+ * @param p Pointer to the philosopher
+ * @return int: milliseconds to back off for
+ */
+int next_backoff_ms(philosopher_t *p);
+
+/**
+ * @brief Initialize all mutexes (every allocated seat, so seats added later already have their hashi)
  * @param sim Pointer to the simulation context
  * @return int: 0 on success, non-zero on error
  */
@@ -87,12 +188,75 @@ int init_hashi(simulation_t *sim);
  * @param sim Pointer to the simulation context
  */
 void cleanup_hashi(simulation_t *sim);
+/**
+ * @brief Initialize resize_mutex and mark the simulation as not running
+ * @param sim Pointer to the simulation context
+ * @return int: 0 on success, non-zero on error
+ *
+ * The caller owns this mutex like it owns the arrays: init before start_simulation, cleanup after it returns,
+ * so add/remove_philosopher called outside a run find running == false instead of a dead mutex.
+ */
+int init_resize_mutex(simulation_t *sim);
+/**
+ * @brief cleanup resize_mutex
+ * @param sim Pointer to the simulation context
+ */
+void cleanup_resize_mutex(simulation_t *sim);
 /**
  * @brief Initialize all philosopher structs
  * @param sim Pointer to the simulation context
+ *
+ * The first num_philosophers seats form the ring, the remaining seats up to max_philosophers are left empty.
  */
 int init_philosophers(simulation_t *sim);
 
+/**
+ * @brief Hunger latency percentile over every meal recorded so far this run (meals on retained hashi count as 0 ms)
+ * @param sim Pointer to the simulation context
+ * @param percentile e.g. 50.0, 99.0, 99.9
+ * @return int: latency in ms (upper edge of the HUNGER_BUCKET_MS bucket it falls in), -1 if nobody has eaten yet
+ */
+int hunger_latency_percentile(simulation_t *sim, double percentile);
+/**
+ * @brief Number of meals recorded so far this run (normal, forced, retained and single-philosopher meals alike)
+ * @param sim Pointer to the simulation context
+ * @return unsigned long: meal count
+ */
+unsigned long total_meals(simulation_t *sim);
+
+/*============== WORKLOAD CONFIG ==============*/
+/**
+ * @brief Fill a workload with the default uniform timings (500-1500 ms think/eat, 50-150 ms backoff) and no trace
+ * @param w Pointer to the workload to initialize
+ */
+void init_workload(workload_t *w);
+/**
+ * @brief Parse a distribution spec
+ * @param spec One of "uniform:MIN,MAX", "exp:MEAN", "lognormal:MU,SIGMA", "pareto:SCALE,ALPHA" or "hist:FILE"
+ *             (FILE holds one "MS WEIGHT" pair per line), all times in milliseconds
+ * @param dist Pointer to the distribution to fill (free a previous histogram with free_distribution first)
+ * @return int: 0 on success, non-zero on error
+ */
+int parse_distribution(const char *spec, distribution_t *dist);
+/**
+ * @brief Free the histogram buckets of a distribution (no-op for the parametric kinds)
+ * @param dist Pointer to the distribution
+ */
+void free_distribution(distribution_t *dist);
+/**
+ * @brief Map a timing trace file for replay
+ * @param w Pointer to the workload
+ * @param path File of native-endian uint32 (think_ms, eat_ms) pairs. Record i goes to seat i % max_philosophers,
+ *             so seat k replays records k, k + max_philosophers, ... and wraps around at the end of the file.
+ * @return int: 0 on success, non-zero on error
+ */
+int load_trace(workload_t *w, const char *path);
+/**
+ * @brief Free everything a workload owns (histograms and the trace mapping)
+ * @param w Pointer to the workload
+ */
+void free_workload(workload_t *w);
+
 /*============== MAIN API ==============*/
 /**
  * @brief Start the endless dining philosophers simulation.
@@ -100,10 +264,30 @@ int init_philosophers(simulation_t *sim);
  * @param duration_seconds the amount of time that user wishes to run the philosophers for (0 is default and infinite)
  *
  * Initializes mutexes, creates the philosopher threads (joins and cleans up, but never executes)
- * Blocks forever until the process is killed.
+ * Blocks forever until the process is killed. Once stopped, prints a hunger latency summary (p50/p99/p99.9/max)
+ * the most neighbor meals any philosopher sat through while hungry, and the total meal count.
  *
  * @return int: 0 on success, non-zero error
  */
 int start_simulation(simulation_t *sim, int duration_seconds);
+/**
+ * @brief Seat a new philosopher (and their hashi) to the right of an existing one while the simulation runs
+ * @param sim Pointer to the simulation context
+ * @param left_id id of the seated philosopher who becomes the new philosopher's left neighbor
+ * @return int: id of the new philosopher on success, -1 on error (no free seat, bad id, single-philosopher mode or not running)
+ *
+ * Only left_id's right hashi changes. It is swapped while holding the old right hashi, and philosophers re-check
+ * their right hashi after locking, so nobody else at the table has to stop.
+ */
+int add_philosopher(simulation_t *sim, int left_id);
+/**
+ * @brief Remove a seated philosopher (and their hashi) from the ring while the simulation runs
+ * @param sim Pointer to the simulation context
+ * @param id id of the philosopher to remove
+ * @return int: 0 on success, -1 on error (bad id, the ring would shrink below two philosophers or not running)
+ *
+ * Blocks until the leaving philosopher has put their hashi down and their thread has been joined.
+ */
+int remove_philosopher(simulation_t *sim, int id);
 
 #endif /* DININGPHILOSOPHERS_H */
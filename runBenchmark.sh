@@ -0,0 +1,35 @@
+#!/bin/bash
+# runBenchmark.sh - Compare hunger latency (first attempt to first bite) of the forced-eat and fair policies
+
+# Default values
+BIN="bin/diningPhilosophers"
+DURATION=60
+PHILOSOPHERS=20
+
+# Parse optional duration/philosophers, anything after them goes to both runs (e.g. --think exp:300)
+if [[ -n $1 && $1 != --* ]]; then
+    DURATION=$1
+    shift
+fi
+
+if [[ -n $1 && $1 != --* ]]; then
+    PHILOSOPHERS=$1
+    shift
+fi
+
+# Check the binary exists
+if [[ ! -f $BIN ]]; then
+    echo "Binary not found: $BIN (run make first)"
+    echo "Usage: $0 [duration_seconds] [philosophers] [binary_args...]"
+    exit 1
+fi
+
+echo "Benchmarking $PHILOSOPHERS philosophers for ${DURATION}s per policy $@"
+echo "NOTE: p99.9 needs 1000+ meals to mean anything, give it a long enough run."
+
+# Same arguments for both, only the policy changes
+for POLICY in "" "--fair"; do
+    OUTPUT=$("$BIN" --duration "$DURATION" --philosophers "$PHILOSOPHERS" $POLICY "$@")
+    # The summary's meal count includes forced meals, which don't log "starts eating"
+    grep "Hunger latency" <<< "$OUTPUT"
+done
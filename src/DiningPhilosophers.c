@@ -5,6 +5,13 @@
 #include <time.h>
 #include <unistd.h>
 #include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Every nap checks for stop/leave/hungry neighbors at least this often
+#define NAP_SLICE_MS 10
 
 /**
  * Update: after helgrind analysis, we weren't using global lock order for our hashi.
@@ -16,53 +23,214 @@
  * I will implement a safe_print helper
  */
 
-void *philosopher_routine(void *arg) {
-    philosopher_t *p = (philosopher_t *)arg; // cast back to philosopher_t ptr
+/**
+ * Hashi retention helpers: after a meal we may hold on to our hashi and think with them in hand,
+ * checking every few milliseconds whether a neighbor got hungry (or we are asked to stop) so we can put them down right away.
+ */
+static bool neighbor_hungry(philosopher_t *p) {
+    return atomic_load(&atomic_load(&p->left_neighbor)->hungry) || atomic_load(&atomic_load(&p->right_neighbor)->hungry);
+}
+
+/**
+ * Every think/eat/backoff sleep goes through here: it sleeps in 10 ms slices so a long (heavy tailed) sample
+ * can't hold up shutdown or remove_philosopher. Returns false if it was cut short.
+ */
+static bool nap(philosopher_t *p, int millisec, bool yield_to_hungry_neighbor) {
     simulation_t *sim = p->sim;
 
-    if (sim->num_philosophers == 1) {
-        return single_philosopher_routine(arg);
+    int remaining = millisec;
+    while (remaining > 0) {
+        if (atomic_load(&sim->stop_flag) || atomic_load(&p->leaving) ||
+            (yield_to_hungry_neighbor && neighbor_hungry(p))) {
+            return false;
+        }
+
+        int slice = (remaining < NAP_SLICE_MS) ? remaining : NAP_SLICE_MS;
+        sleep_ms(slice);
+        remaining -= slice;
+    }
+
+    return true;
+}
+
+static bool retain_hashi(philosopher_t *p, int meals) {
+    if (meals >= p->sim->retain_meals) {
+        return false;
     }
 
-    // Get global indexes for the mutexes (based of the thread ids)
-    const int left_idx = p->id;
-    const int right_idx =(p->id + 1) % sim->num_philosophers;
+    // "Think" as usual, but put the hashi down as soon as a neighbor is hungry
+    atomic_store(&p->retaining, true);
+    bool keep = nap(p, next_think_ms(p), true) && !neighbor_hungry(p);
+    if (keep) {
+        atomic_store(&p->retaining, false); // eating again, not just sitting on them
+    }
+    return keep;
+}
 
-    // Update for global ordering/always attempt the lower indexed hashi first
-    pthread_mutex_t *first_hashi = (left_idx < right_idx) ? p->left_hashi : p->right_hashi;
-    pthread_mutex_t *second_hashi = (left_idx < right_idx) ? p->right_hashi : p->left_hashi;
+static bool neighbor_retaining(philosopher_t *p) {
+    return atomic_load(&atomic_load(&p->left_neighbor)->retaining) || atomic_load(&atomic_load(&p->right_neighbor)->retaining);
+}
 
-    int left_neighbor = (p->id + sim->num_philosophers - 1) % sim->num_philosophers;
-    int right_neighbor = (p->id + 1) % sim->num_philosophers;
+/**
+ * trylock, except when a neighbor is sitting on their hashi: they put them down within one nap slice of seeing us hungry,
+ * so we wait for that handoff instead of failing and going back to think (which would cost far more than retention saves).
+ */
+static int trylock_hashi(philosopher_t *p, pthread_mutex_t *hashi) {
+    int rc = pthread_mutex_trylock(hashi);
+
+    int waited = 0;
+    while (rc != 0 && waited < 2 * NAP_SLICE_MS && neighbor_retaining(p)) {
+        sleep_ms(1);
+        ++waited;
+        rc = pthread_mutex_trylock(hashi);
+    }
 
-    while (!atomic_load(&sim->stop_flag)) {
+    // The retainer unlocks before clearing `retaining`, so one more try catches a handoff between our last try and the check
+    if (rc != 0 && waited > 0) {
+        rc = pthread_mutex_trylock(hashi);
+    }
+
+    return rc;
+}
+
+/**
+ * Fairness helpers: a hunger ticket comes from a sim-wide counter, taken once per hunger (not per attempt), so tickets
+ * are strictly ordered even when two hungers start in the same millisecond. Latency is timed separately with now_ms()
+ * and every meal files it into sim->hunger_histogram for the end-of-run summary.
+ */
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void become_hungry(philosopher_t *p) {
+    if (!atomic_load(&p->hungry)) {
+        atomic_store(&p->meals_skipped, 0);
+        atomic_store(&p->hungry_since_ms, now_ms());
+        // ticket before the flag, so whoever sees us hungry sees this ticket
+        atomic_store(&p->hunger_ticket, atomic_fetch_add(&p->sim->next_hunger_ticket, 1));
+        atomic_store(&p->hungry, true);
+    }
+}
+
+static void record_hunger_latency(simulation_t *sim, long waited) {
+    long bucket = waited / HUNGER_BUCKET_MS;
+    atomic_fetch_add(&sim->hunger_histogram[(bucket < HUNGER_BUCKETS) ? bucket : HUNGER_BUCKETS - 1], 1);
+}
+
+static void stop_being_hungry(philosopher_t *p) {
+    record_hunger_latency(p->sim, now_ms() - atomic_load(&p->hungry_since_ms));
+
+    int skipped = atomic_load(&p->meals_skipped);
+    if (skipped > p->most_meals_skipped) {
+        p->most_meals_skipped = skipped;
+    }
+    atomic_store(&p->hungry, false);
+}
+
+// Called as we start a meal: a hungry neighbor just had to skip it
+static void count_skipped_meal(philosopher_t *p) {
+    philosopher_t *left = atomic_load(&p->left_neighbor);
+    philosopher_t *right = atomic_load(&p->right_neighbor);
+
+    if (atomic_load(&left->hungry)) {
+        atomic_fetch_add(&left->meals_skipped, 1);
+    }
+    if (right != left && atomic_load(&right->hungry)) { // a ring of two has the same neighbor on both sides
+        atomic_fetch_add(&right->meals_skipped, 1);
+    }
+}
+
+// Is this neighbor hungry since before us? Tickets are unique, so two neighbors never both defer.
+static bool hungry_before_us(philosopher_t *p, philosopher_t *neighbor) {
+    if (!atomic_load(&neighbor->hungry)) {
+        return false;
+    }
+
+    return atomic_load(&neighbor->hunger_ticket) < atomic_load(&p->hunger_ticket);
+}
+
+static bool defer_to_neighbor(philosopher_t *p) {
+    return hungry_before_us(p, atomic_load(&p->left_neighbor)) || hungry_before_us(p, atomic_load(&p->right_neighbor));
+}
+
+void *philosopher_routine(void *arg) {
+    philosopher_t *p = (philosopher_t *)arg; // cast back to philosopher_t ptr
+    simulation_t *sim = p->sim;
+
+    // Only a ring of one has the same hashi on both sides (don't read num_philosophers here, it changes on resize)
+    if (p->left_hashi == atomic_load(&p->right_hashi)) {
+        return single_philosopher_routine(arg);
+    }
+
+    while (!atomic_load(&sim->stop_flag) && !atomic_load(&p->leaving)) {
         // THINK
-        // "Think" for 500 - 1500 ms
-        sleep_ms(rand() % 1000 + 500);
+        // "Think" for a workload-drawn time (500 - 1500 ms by default)
+        // In fair mode a philosopher who is still hungry goes straight back to trying, thinking again would only add to their wait
+        if ((!sim->fair_mode || !atomic_load(&p->hungry)) && !nap(p, next_think_ms(p), false)) {
+            continue; // cut short because we're stopping/leaving, don't start another attempt
+        }
+
+        // Our right hashi can be swapped by add/remove_philosopher, so pick it up fresh every attempt.
+        // Global ordering is by address: every hashi lives in the same array, so that's the same as lowest index first.
+        pthread_mutex_t *right_hashi = atomic_load(&p->right_hashi);
+        pthread_mutex_t *first_hashi = (p->left_hashi < right_hashi) ? p->left_hashi : right_hashi;
+        pthread_mutex_t *second_hashi = (p->left_hashi < right_hashi) ? right_hashi : p->left_hashi;
 
         // ATTEMPTING TO EAT
-        if (pthread_mutex_trylock(first_hashi) == 0) {         // Try to pick up smallest indexed hashi
-            if (pthread_mutex_trylock(second_hashi) == 0) {    // Try to pick up the other possible hashi
-                // EAT
-                atomic_store(&p->state, EATING);
-                // This technically should not happen since we'd need to have the mutexes available to get here.
-                if (atomic_load(&sim->philosophers[left_neighbor].state) == EATING ||
-                    atomic_load(&sim->philosophers[right_neighbor].state) == EATING) {
-                    safe_printf(sim, "Philosopher %d ate with his hands, GROSS! (violation)\n", p->id);
-                    p->violation_flag = VIOLATION;
+        become_hungry(p);
+        if (sim->fair_mode && defer_to_neighbor(p)) {
+            // A neighbor has been hungry longer, leave the hashi for them
+            ++p->starvation_counter;
+        } else if (trylock_hashi(p, first_hashi) == 0) {       // Try to pick up smallest indexed hashi
+            if (trylock_hashi(p, second_hashi) == 0) {         // Try to pick up the other possible hashi
+                // The ring was resized between reading and locking, these aren't our hashi anymore
+                if (atomic_load(&p->right_hashi) != right_hashi) {
+                    pthread_mutex_unlock(second_hashi);
+                    pthread_mutex_unlock(first_hashi);
+                    continue;
                 }
 
-                safe_printf(sim, "Philosopher %d starts eating\n", p->id);
-                sleep_ms(rand() % 1000 + 500);
-                safe_printf(sim, "Philosopher %d stops eating\n", p->id);
-
-                // RESET
-                atomic_store(&p->state, THINKING);
-                p->starvation_counter = 0;
+                stop_being_hungry(p);
+
+                // Keep eating on these hashi while nobody next to us wants them (only loops with retain_meals set)
+                int meals = 0;
+                do {
+                    if (meals > 0) {
+                        // Never had to wait for this one, it still counts in the latency percentiles
+                        record_hunger_latency(sim, 0);
+                        safe_printf(sim, "Philosopher %d keeps their hashi for another meal\n", p->id);
+                    }
+
+                    // EAT
+                    atomic_store(&p->state, EATING);
+                    // This technically should not happen since we'd need to have the mutexes available to get here.
+                    if (atomic_load(&atomic_load(&p->left_neighbor)->state) == EATING ||
+                        atomic_load(&atomic_load(&p->right_neighbor)->state) == EATING) {
+                        safe_printf(sim, "Philosopher %d ate with his hands, GROSS! (violation)\n", p->id);
+                        p->violation_flag = VIOLATION;
+                    }
+
+                    count_skipped_meal(p);
+                    safe_printf(sim, "Philosopher %d starts eating\n", p->id);
+                    nap(p, next_eat_ms(p), false);
+                    safe_printf(sim, "Philosopher %d stops eating\n", p->id);
+
+                    // RESET
+                    atomic_store(&p->state, THINKING);
+                    p->starvation_counter = 0;
+                    ++meals;
+                } while (retain_hashi(p, meals));
+
+                if (meals > p->longest_meal_streak) {
+                    p->longest_meal_streak = meals;
+                }
 
                 // RELEASE HASHI
                 pthread_mutex_unlock(second_hashi);
                 pthread_mutex_unlock(first_hashi);
+                atomic_store(&p->retaining, false); // only after unlocking, see trylock_hashi
             } else {
                 // SECOND HASHI IS UNAVAILABLE
                 // Put the first hashi down and try later
@@ -74,8 +242,8 @@ void *philosopher_routine(void *arg) {
             ++p->starvation_counter;
         }
 
-        // Handle starving philosophers checkpoint
-        if (p->starvation_counter >= 10) {
+        // Handle starving philosophers checkpoint (fair mode never needs it, older hungry neighbors already go first)
+        if (!sim->fair_mode && p->starvation_counter >= 10) {
             safe_printf(sim, "Philosopher %d is starving! Attempts: %d\n", p->id, p->starvation_counter);
             // We can do forced acquisition in here or some priority track,
             // or just increase our back off timer to help with further desyncing below
@@ -85,20 +253,28 @@ void *philosopher_routine(void *arg) {
             pthread_mutex_lock(first_hashi);
             pthread_mutex_lock(second_hashi);
 
-            safe_printf(sim, "Philosopher %d is being forced to eat\n", p->id);
-            sleep_ms(rand() % 1000 + 500);
-            safe_printf(sim, "Philosopher %d no longer being forced to eat\n", p->id);
+            // Same re-check as above, if we were resized we go around again without resetting the counter
+            if (atomic_load(&p->right_hashi) == right_hashi) {
+                stop_being_hungry(p);
+                count_skipped_meal(p);
+                safe_printf(sim, "Philosopher %d is being forced to eat\n", p->id);
+                nap(p, next_eat_ms(p), false);
+                safe_printf(sim, "Philosopher %d no longer being forced to eat\n", p->id);
+
+                p->starvation_counter = 0;
+            }
 
             pthread_mutex_unlock(second_hashi);
             pthread_mutex_unlock(first_hashi);
-
-            p->starvation_counter = 0;
         }
 
         // short delay before next attempt
-        sleep_ms(rand() % 100 + 50);
+        nap(p, next_backoff_ms(p), false);
     }
 
+    // Don't leave neighbors deferring to someone who left the table
+    atomic_store(&p->hungry, false);
+
     // Technically never hit, but needed
     return NULL;
 }
@@ -109,13 +285,16 @@ void *single_philosopher_routine(void *arg) {
 
     while (!atomic_load(&sim->stop_flag)) {
         // THINK
-        sleep_ms(rand() % 1000 + 500);
+        if (!nap(p, next_think_ms(p), false)) {
+            break; // stopping
+        }
         pthread_mutex_trylock(p->left_hashi); // only possible hashi (we could technically just use lock)
 
         // EATING
         atomic_store(&p->state, EATING);
+        record_hunger_latency(sim, 0); // nobody to wait on
         safe_printf(sim, "Philosopher %d starts eating (single-philosopher mode)\n", p->id);
-        sleep_ms(rand() % 1000 + 500);
+        nap(p, next_eat_ms(p), false);
         safe_printf(sim, "Philosopher %d stops eating (single-philosopher mode)\n", p->id);
 
         // RESET
@@ -148,12 +327,326 @@ void sleep_ms(int millisec) {
     nanosleep(&ts, NULL); // perform the sleep here
 }
 
+unsigned long total_meals(simulation_t *sim) {
+    unsigned long total = 0;
+    for (int i = 0; i < HUNGER_BUCKETS; ++i) {
+        total += atomic_load(&sim->hunger_histogram[i]);
+    }
+    return total;
+}
+
+int hunger_latency_percentile(simulation_t *sim, double percentile) {
+    unsigned long total = total_meals(sim);
+
+    if (total == 0) {
+        return -1;
+    }
+
+    // Smallest bucket that covers percentile% of the meals (rounded up, so p100 is the max)
+    double wanted = total * percentile / 100.0;
+    unsigned long seen = 0;
+    for (int i = 0; i < HUNGER_BUCKETS; ++i) {
+        seen += atomic_load(&sim->hunger_histogram[i]);
+        if (seen > 0 && seen >= wanted) {
+            return (i + 1) * HUNGER_BUCKET_MS;
+        }
+    }
+
+    return HUNGER_BUCKETS * HUNGER_BUCKET_MS;
+}
+
+/**
+ * Workload sampling: each philosopher draws from their own xorshift64* state and refills a whole batch at once,
+ * so distribution math (log/exp/pow or a histogram search) happens once per WORKLOAD_BATCH events, off the lock path.
+ */
+static const workload_t default_workload = {
+    .think = { .kind = DIST_UNIFORM, .a = 500, .b = 1500 },
+    .eat = { .kind = DIST_UNIFORM, .a = 500, .b = 1500 },
+    .backoff = { .kind = DIST_UNIFORM, .a = 50, .b = 150 },
+};
+
+static uint64_t next_random(philosopher_t *p) {
+    p->rng_state ^= p->rng_state >> 12;
+    p->rng_state ^= p->rng_state << 25;
+    p->rng_state ^= p->rng_state >> 27;
+    return p->rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform in [0, 1)
+static double next_unit(philosopher_t *p) {
+    return (next_random(p) >> 11) * (1.0 / 9007199254740992.0); // top 53 bits / 2^53
+}
+
+static int sample_distribution(philosopher_t *p, const distribution_t *dist) {
+    double u = next_unit(p);
+    double ms = 0;
+
+    switch (dist->kind) {
+    case DIST_UNIFORM:
+        ms = dist->a + u * (dist->b - dist->a);
+        break;
+    case DIST_EXPONENTIAL:
+        ms = -dist->a * log(1.0 - u);
+        break;
+    case DIST_LOGNORMAL: {
+        // Box-Muller, we only need one of the pair (M_PI isn't in strict C11)
+        const double two_pi = 6.283185307179586;
+        double u2 = next_unit(p);
+        ms = exp(dist->a + dist->b * sqrt(-2.0 * log(1.0 - u)) * cos(two_pi * u2));
+        break;
+    }
+    case DIST_PARETO:
+        ms = dist->a / pow(1.0 - u, 1.0 / dist->b);
+        break;
+    case DIST_HISTOGRAM: {
+        // first bucket whose running total passes u
+        int lo = 0;
+        int hi = dist->histogram_size - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (dist->histogram_cdf[mid] > u) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        ms = dist->histogram_ms[lo];
+        break;
+    }
+    }
+
+    if (!(ms >= 0)) { // also catches NaN, casting that to int is undefined
+        return 0;
+    }
+    return (ms > WORKLOAD_MAX_MS) ? WORKLOAD_MAX_MS : (int)ms;
+}
+
+static void refill_batch(philosopher_t *p, sample_batch_t *batch, const distribution_t *dist) {
+    for (int i = 0; i < WORKLOAD_BATCH; ++i) {
+        batch->samples[i] = sample_distribution(p, dist);
+    }
+    batch->next = 0;
+}
+
+/** One field of our current trace record, think and eat come from the same record so a meal cycle replays as recorded */
+static int trace_ms(const philosopher_t *p, const workload_t *w, int field) {
+    // Our records are id, id + stride, id + 2 * stride, ... wrapping at the end of the trace
+    size_t stride = (size_t)p->sim->max_philosophers;
+    size_t record = ((size_t)p->id + p->trace_next * stride) % w->trace_records;
+    uint32_t ms = w->trace[record * 2 + field];
+    return (ms > WORKLOAD_MAX_MS) ? WORKLOAD_MAX_MS : (int)ms;
+}
+
+static void reset_batches(philosopher_t *p) {
+    // Seed from rand() so srand() in start_simulation still decides the run, never 0 (xorshift would stay at 0)
+    p->rng_state = ((uint64_t)rand() << 32) ^ (uint64_t)rand() ^ ((uint64_t)p->id << 16) ^ 1;
+
+    p->think_batch.next = WORKLOAD_BATCH;
+    p->eat_batch.next = WORKLOAD_BATCH;
+    p->backoff_batch.next = WORKLOAD_BATCH;
+    p->trace_next = 0;
+}
+
+int next_think_ms(philosopher_t *p) {
+    const workload_t *w = p->sim->workload ? p->sim->workload : &default_workload;
+    if (w->trace) {
+        return trace_ms(p, w, 0); // the record only moves on once we've eaten
+    }
+
+    if (p->think_batch.next == WORKLOAD_BATCH) {
+        refill_batch(p, &p->think_batch, &w->think);
+    }
+    return p->think_batch.samples[p->think_batch.next++];
+}
+
+int next_eat_ms(philosopher_t *p) {
+    const workload_t *w = p->sim->workload ? p->sim->workload : &default_workload;
+    if (w->trace) {
+        int ms = trace_ms(p, w, 1);
+        ++p->trace_next; // this meal cycle is done
+        return ms;
+    }
+
+    if (p->eat_batch.next == WORKLOAD_BATCH) {
+        refill_batch(p, &p->eat_batch, &w->eat);
+    }
+    return p->eat_batch.samples[p->eat_batch.next++];
+}
+
+int next_backoff_ms(philosopher_t *p) {
+    if (p->backoff_batch.next == WORKLOAD_BATCH) {
+        const workload_t *w = p->sim->workload ? p->sim->workload : &default_workload;
+        refill_batch(p, &p->backoff_batch, &w->backoff); // the trace only has think/eat times
+    }
+    return p->backoff_batch.samples[p->backoff_batch.next++];
+}
+
+void init_workload(workload_t *w) {
+    *w = default_workload;
+}
+
+/** Reads "MS WEIGHT" lines into a histogram distribution */
+static int load_histogram(const char *path, distribution_t *dist) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: could not open histogram file %s\n", path);
+        return -1;
+    }
+
+    int capacity = 16;
+    int size = 0;
+    int *ms = malloc(sizeof(int) * capacity);
+    double *cdf = malloc(sizeof(double) * capacity);
+    double total = 0;
+    int value = 0;
+    double weight = 0;
+
+    while (ms && cdf && fscanf(f, "%d %lf", &value, &weight) == 2) {
+        if (value < 0 || weight < 0 || !isfinite(weight)) {
+            break; // caught below, we didn't reach EOF
+        }
+
+        if (size == capacity) {
+            capacity *= 2;
+            int *grown_ms = realloc(ms, sizeof(int) * capacity);
+            double *grown_cdf = realloc(cdf, sizeof(double) * capacity);
+            ms = grown_ms ? grown_ms : ms;
+            cdf = grown_cdf ? grown_cdf : cdf;
+            if (!grown_ms || !grown_cdf) {
+                break;
+            }
+        }
+
+        total += weight;
+        ms[size] = value;
+        cdf[size] = total;
+        ++size;
+    }
+
+    bool complete = feof(f);
+    fclose(f);
+
+    if (!ms || !cdf || !complete || size == 0 || total <= 0 || !isfinite(total)) {
+        fprintf(stderr, "Error: invalid histogram file %s (expected \"MS WEIGHT\" lines)\n", path);
+        free(ms);
+        free(cdf);
+        return -1;
+    }
+
+    for (int i = 0; i < size; ++i) {
+        cdf[i] /= total;
+    }
+    cdf[size - 1] = 1.0; // don't let rounding leave a gap at the top
+
+    dist->kind = DIST_HISTOGRAM;
+    dist->a = 0;
+    dist->b = 0;
+    dist->histogram_size = size;
+    dist->histogram_ms = ms;
+    dist->histogram_cdf = cdf;
+    return 0;
+}
+
+int parse_distribution(const char *spec, distribution_t *dist) {
+    distribution_t parsed = { 0 };
+    int consumed = 0;
+
+    if (strncmp(spec, "hist:", 5) == 0) {
+        if (load_histogram(spec + 5, &parsed) != 0) {
+            return -1;
+        }
+    } else if (sscanf(spec, "uniform:%lf,%lf%n", &parsed.a, &parsed.b, &consumed) == 2 && spec[consumed] == '\0') {
+        parsed.kind = DIST_UNIFORM;
+        if (parsed.a < 0 || parsed.b <= parsed.a) {
+            return -1;
+        }
+    } else if (sscanf(spec, "exp:%lf%n", &parsed.a, &consumed) == 1 && spec[consumed] == '\0') {
+        parsed.kind = DIST_EXPONENTIAL;
+        if (parsed.a <= 0) {
+            return -1;
+        }
+    } else if (sscanf(spec, "lognormal:%lf,%lf%n", &parsed.a, &parsed.b, &consumed) == 2 && spec[consumed] == '\0') {
+        parsed.kind = DIST_LOGNORMAL;
+        if (parsed.b < 0) {
+            return -1;
+        }
+    } else if (sscanf(spec, "pareto:%lf,%lf%n", &parsed.a, &parsed.b, &consumed) == 2 && spec[consumed] == '\0') {
+        parsed.kind = DIST_PARETO;
+        if (parsed.a <= 0 || parsed.b <= 0) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+
+    // %lf happily reads "nan" and "inf", which slip past the checks above and make the sampled ms meaningless
+    if (parsed.kind != DIST_HISTOGRAM && (!isfinite(parsed.a) || !isfinite(parsed.b))) {
+        return -1;
+    }
+
+    *dist = parsed;
+    return 0;
+}
+
+void free_distribution(distribution_t *dist) {
+    if (dist->kind != DIST_HISTOGRAM) {
+        return;
+    }
+
+    free(dist->histogram_ms);
+    free(dist->histogram_cdf);
+    dist->histogram_ms = NULL;
+    dist->histogram_cdf = NULL;
+    dist->histogram_size = 0;
+}
+
+int load_trace(workload_t *w, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: could not open trace file %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(sizeof(uint32_t) * 2)) {
+        fprintf(stderr, "Error: trace file %s has no (think_ms, eat_ms) records\n", path);
+        close(fd);
+        return -1;
+    }
+
+    // Map it read-only and let the page cache stream it in, a trace can be far bigger than we'd want to read up front
+    void *mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference
+    if (mapped == MAP_FAILED) {
+        fprintf(stderr, "Error: could not map trace file %s\n", path);
+        return -1;
+    }
+
+    w->trace = mapped;
+    w->trace_bytes = (size_t)st.st_size;
+    w->trace_records = w->trace_bytes / (sizeof(uint32_t) * 2); // a trailing partial record is ignored
+    return 0;
+}
+
+void free_workload(workload_t *w) {
+    free_distribution(&w->think);
+    free_distribution(&w->eat);
+    free_distribution(&w->backoff);
+
+    if (w->trace) {
+        munmap((void *)w->trace, w->trace_bytes);
+        w->trace = NULL;
+        w->trace_bytes = 0;
+        w->trace_records = 0;
+    }
+}
+
 int init_hashi(simulation_t *sim) {
     if (!sim->hashi) {
         return -1;
     }
 
-    for (int i = 0; i < sim->num_philosophers; ++i) {
+    for (int i = 0; i < sim->max_philosophers; ++i) {
         if (pthread_mutex_init(&sim->hashi[i], NULL) != 0) {
             fprintf(stderr, "Failed to init hashi %d\n", i);
 
@@ -172,11 +665,25 @@ void cleanup_hashi(simulation_t *sim) {
         return;
     }
 
-    for (int i = 0; i < sim->num_philosophers; ++i) {
+    for (int i = 0; i < sim->max_philosophers; ++i) {
         pthread_mutex_destroy(&sim->hashi[i]);
     }
 }
 
+int init_resize_mutex(simulation_t *sim) {
+    if (pthread_mutex_init(&sim->resize_mutex, NULL) != 0) {
+        fprintf(stderr, "Failed to init resize_mutex\n");
+        return -1;
+    }
+
+    sim->running = false;
+    return 0;
+}
+
+void cleanup_resize_mutex(simulation_t *sim) {
+    pthread_mutex_destroy(&sim->resize_mutex);
+}
+
 int init_philosophers(simulation_t *sim) {
     if (!sim->philosophers || !sim->hashi) {
         return -1;
@@ -187,9 +694,37 @@ int init_philosophers(simulation_t *sim) {
         sim->philosophers[i].id = i;
         atomic_store(&sim->philosophers[i].state, THINKING);
         sim->philosophers[i].left_hashi = &sim->hashi[i];
-        sim->philosophers[i].right_hashi = &sim->hashi[(i + 1) % sim->num_philosophers];
+        atomic_store(&sim->philosophers[i].right_hashi, &sim->hashi[(i + 1) % sim->num_philosophers]);
+        atomic_store(&sim->philosophers[i].left_neighbor, &sim->philosophers[(i + sim->num_philosophers - 1) % sim->num_philosophers]);
+        atomic_store(&sim->philosophers[i].right_neighbor, &sim->philosophers[(i + 1) % sim->num_philosophers]);
         sim->philosophers[i].starvation_counter = 0;
+        sim->philosophers[i].longest_meal_streak = 0;
+        atomic_store(&sim->philosophers[i].hungry, false);
+        atomic_store(&sim->philosophers[i].retaining, false);
+        atomic_store(&sim->philosophers[i].hunger_ticket, 0);
+        atomic_store(&sim->philosophers[i].hungry_since_ms, 0);
+        atomic_store(&sim->philosophers[i].meals_skipped, 0);
+        sim->philosophers[i].most_meals_skipped = 0;
         sim->philosophers[i].violation_flag = 0;
+        sim->philosophers[i].seated = true;
+        atomic_store(&sim->philosophers[i].leaving, false);
+        sim->philosophers[i].sim = sim;
+        reset_batches(&sim->philosophers[i]);
+    }
+
+    // Spare seats stay empty until add_philosopher() fills them
+    for (int i = sim->num_philosophers; i < sim->max_philosophers; ++i) {
+        sim->philosophers[i].id = i;
+        atomic_store(&sim->philosophers[i].state, THINKING);
+        sim->philosophers[i].longest_meal_streak = 0;
+        atomic_store(&sim->philosophers[i].hungry, false);
+        atomic_store(&sim->philosophers[i].retaining, false);
+        atomic_store(&sim->philosophers[i].hunger_ticket, 0);
+        atomic_store(&sim->philosophers[i].hungry_since_ms, 0);
+        atomic_store(&sim->philosophers[i].meals_skipped, 0);
+        sim->philosophers[i].most_meals_skipped = 0;
+        sim->philosophers[i].violation_flag = OK;
+        sim->philosophers[i].seated = false;
         sim->philosophers[i].sim = sim;
     }
 
@@ -203,6 +738,11 @@ int start_simulation(simulation_t *sim, int duration_seconds) {
         return -1;
     }
 
+    if (sim->max_philosophers < sim->num_philosophers) {
+        fprintf(stderr, "Error: max_philosophers must be at least num_philosophers!\n");
+        return -1;
+    }
+
     /*
         The original spirit/semantics of Dining Philosophers say that a single philosopher should not be eating,
         but requirements are saying he should (or are at least ambiguous enough to say he should),
@@ -217,6 +757,12 @@ int start_simulation(simulation_t *sim, int duration_seconds) {
     // SEED TIME FOR RAND()
     srand(time(NULL));
 
+    // RESET HUNGER TICKETS AND LATENCY HISTOGRAM
+    atomic_store(&sim->next_hunger_ticket, 0);
+    for (int i = 0; i < HUNGER_BUCKETS; ++i) {
+        atomic_store(&sim->hunger_histogram[i], 0);
+    }
+
     // INITIALIZE OUR MUTEXES(hashi)
     if (init_hashi(sim) != 0) {
         fprintf(stderr, "Error: initializing hashi!\n");
@@ -255,6 +801,11 @@ int start_simulation(simulation_t *sim, int duration_seconds) {
         }
     }
 
+    // Threads are up, add/remove_philosopher may resize the ring from here on
+    pthread_mutex_lock(&sim->resize_mutex);
+    sim->running = true;
+    pthread_mutex_unlock(&sim->resize_mutex);
+
     if (duration_seconds > 0) {
         safe_printf(sim, "Run for duration: %d seconds\n", duration_seconds);
         sleep_ms(duration_seconds * 1000); // convert to milliseconds
@@ -268,11 +819,30 @@ int start_simulation(simulation_t *sim, int duration_seconds) {
     }
 
     // JOIN THREADS, (technically this never should be reached, because we're endless)
-    for (int i = 0; i < sim->num_philosophers; ++i) {
-        pthread_join(sim->philosophers[i].thread_id, NULL);
+    // Seats may have been added or removed, so walk every seat and hold resize_mutex so nobody is mid-resize
+    pthread_mutex_lock(&sim->resize_mutex);
+    sim->running = false;
+    for (int i = 0; i < sim->max_philosophers; ++i) {
+        if (sim->philosophers[i].seated) {
+            pthread_join(sim->philosophers[i].thread_id, NULL);
+        }
+    }
+    pthread_mutex_unlock(&sim->resize_mutex);
+
+    // HUNGER LATENCY SUMMARY (what runBenchmark.sh compares between policies)
+    int most_meals_skipped = 0;
+    for (int i = 0; i < sim->max_philosophers; ++i) {
+        if (sim->philosophers[i].seated && sim->philosophers[i].most_meals_skipped > most_meals_skipped) {
+            most_meals_skipped = sim->philosophers[i].most_meals_skipped;
+        }
     }
+    safe_printf(sim, "Hunger latency (%s policy, ms): p50 %d, p99 %d, p99.9 %d, max %d, most neighbor meals skipped %d, meals %lu\n",
+                sim->fair_mode ? "fair" : "forced-eat",
+                hunger_latency_percentile(sim, 50.0), hunger_latency_percentile(sim, 99.0),
+                hunger_latency_percentile(sim, 99.9), hunger_latency_percentile(sim, 100.0), most_meals_skipped,
+                total_meals(sim));
 
-    // DESTROY thread_safe_print_mutex
+    // DESTROY thread_safe_print_mutex (resize_mutex belongs to the caller, see init_resize_mutex)
     pthread_mutex_destroy(&sim->thread_safe_print_mutex);
 
     // DESTROY MUTEXES(hashi) ON EXIT, (also technically unreachable in this program, since we are running endlessly)
@@ -280,3 +850,129 @@ int start_simulation(simulation_t *sim, int duration_seconds) {
 
     return 0;
 }
+
+int add_philosopher(simulation_t *sim, int left_id) {
+    pthread_mutex_lock(&sim->resize_mutex);
+
+    // Single-philosopher mode runs a different routine, so we only grow rings that already have neighbors
+    if (!sim->running || atomic_load(&sim->stop_flag) || sim->num_philosophers < 2 ||
+        left_id < 0 || left_id >= sim->max_philosophers || !sim->philosophers[left_id].seated) {
+        pthread_mutex_unlock(&sim->resize_mutex);
+        return -1;
+    }
+
+    // FIND AN EMPTY SEAT
+    int id = -1;
+    for (int i = 0; i < sim->max_philosophers; ++i) {
+        if (!sim->philosophers[i].seated) {
+            id = i;
+            break;
+        }
+    }
+
+    if (id < 0) {
+        fprintf(stderr, "Error: no free seat for a new philosopher (max_philosophers: %d)\n", sim->max_philosophers);
+        pthread_mutex_unlock(&sim->resize_mutex);
+        return -1;
+    }
+
+    philosopher_t *left = &sim->philosophers[left_id];
+    philosopher_t *right = atomic_load(&left->right_neighbor);
+    pthread_mutex_t *shared_hashi = atomic_load(&left->right_hashi); // currently between left and right, becomes ours
+
+    // SET UP THE NEW SEAT (its hashi was already initialized by init_hashi)
+    philosopher_t *p = &sim->philosophers[id];
+    p->id = id;
+    atomic_store(&p->state, THINKING);
+    p->left_hashi = &sim->hashi[id];
+    atomic_store(&p->right_hashi, shared_hashi);
+    atomic_store(&p->left_neighbor, left);
+    atomic_store(&p->right_neighbor, right);
+    p->starvation_counter = 0;
+    p->longest_meal_streak = 0;
+    atomic_store(&p->hungry, false);
+    atomic_store(&p->retaining, false);
+    atomic_store(&p->hunger_ticket, 0);
+    atomic_store(&p->hungry_since_ms, 0);
+    atomic_store(&p->meals_skipped, 0);
+    p->most_meals_skipped = 0;
+    p->violation_flag = OK;
+    atomic_store(&p->leaving, false);
+    p->sim = sim;
+    reset_batches(p);
+
+    // Hand our left neighbor the new hashi while holding the one they lose, so they can't be eating with it.
+    // Anyone who grabbed it before the swap sees the change after locking and puts it back down.
+    pthread_mutex_lock(shared_hashi);
+    atomic_store(&left->right_hashi, p->left_hashi);
+    atomic_store(&left->right_neighbor, p);
+    atomic_store(&right->left_neighbor, p);
+    pthread_mutex_unlock(shared_hashi);
+
+    int rc = pthread_create(&p->thread_id, NULL, philosopher_routine, p);
+    if (rc != 0) {
+        fprintf(stderr, "Error: pthread_create failed for philosopher %d: %s\n", id, strerror(rc));
+
+        // Undo the swap, the new hashi is only referenced by left now
+        pthread_mutex_lock(p->left_hashi);
+        atomic_store(&left->right_hashi, shared_hashi);
+        atomic_store(&left->right_neighbor, right);
+        atomic_store(&right->left_neighbor, left);
+        pthread_mutex_unlock(p->left_hashi);
+
+        pthread_mutex_unlock(&sim->resize_mutex);
+        return -1;
+    }
+
+    p->seated = true;
+    ++sim->num_philosophers;
+
+    // Print before unlocking, start_simulation can't tear down the print mutex while we hold resize_mutex
+    safe_printf(sim, "Philosopher %d joins the table right of philosopher %d\n", id, left_id);
+    pthread_mutex_unlock(&sim->resize_mutex);
+
+    return id;
+}
+
+int remove_philosopher(simulation_t *sim, int id) {
+    pthread_mutex_lock(&sim->resize_mutex);
+
+    // A ring of one would need the single-philosopher routine, so we stop shrinking at two
+    if (!sim->running || atomic_load(&sim->stop_flag) || sim->num_philosophers <= 2 ||
+        id < 0 || id >= sim->max_philosophers || !sim->philosophers[id].seated) {
+        pthread_mutex_unlock(&sim->resize_mutex);
+        return -1;
+    }
+
+    philosopher_t *p = &sim->philosophers[id];
+    philosopher_t *left = atomic_load(&p->left_neighbor);
+    philosopher_t *right = atomic_load(&p->right_neighbor);
+
+    // Let them finish whatever meal they're in and leave, after this they hold no hashi
+    atomic_store(&p->leaving, true);
+    pthread_join(p->thread_id, NULL);
+
+    // Give our left neighbor our right hashi. Hold both the hashi they lose and the one they gain (global order)
+    // so neither side can be mid-meal across the swap.
+    pthread_mutex_t *old_hashi = p->left_hashi;
+    pthread_mutex_t *new_hashi = atomic_load(&p->right_hashi);
+    pthread_mutex_t *first_hashi = (old_hashi < new_hashi) ? old_hashi : new_hashi;
+    pthread_mutex_t *second_hashi = (old_hashi < new_hashi) ? new_hashi : old_hashi;
+
+    pthread_mutex_lock(first_hashi);
+    pthread_mutex_lock(second_hashi);
+    atomic_store(&left->right_hashi, new_hashi);
+    atomic_store(&left->right_neighbor, right);
+    atomic_store(&right->left_neighbor, left);
+    pthread_mutex_unlock(second_hashi);
+    pthread_mutex_unlock(first_hashi);
+
+    // The seat's hashi stays initialized (cleanup_hashi destroys every seat), so a stale trylock on it is harmless
+    p->seated = false;
+    --sim->num_philosophers;
+
+    safe_printf(sim, "Philosopher %d leaves the table\n", id);
+    pthread_mutex_unlock(&sim->resize_mutex);
+
+    return 0;
+}
@@ -20,11 +20,58 @@
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
+#include <signal.h>
+
+/** Operator resize control: SIGUSR1 seats another philosopher, SIGUSR2 removes one */
+typedef struct {
+    simulation_t *sim;
+    sigset_t signals;   // SIGUSR1/SIGUSR2, blocked in every thread so only sigtimedwait below takes them
+    atomic_bool done;   // the simulation is over, stop waiting for signals
+} resize_control_t;
+
+static void *resize_control_routine(void *arg) {
+    resize_control_t *control = (resize_control_t *)arg;
+    simulation_t *sim = control->sim;
+    struct timespec poll = { .tv_sec = 0, .tv_nsec = 100 * 1000000L }; // wake up now and then to see if we're done
+
+    while (!atomic_load(&control->done)) {
+        int sig = sigtimedwait(&control->signals, NULL, &poll);
+        if (sig == SIGUSR1) {
+            // Seat 0 is never removed (we remove from the highest seat down and the ring stops at two), so it's always a valid neighbor
+            if (add_philosopher(sim, 0) < 0) {
+                fprintf(stderr, "Notice: could not add a philosopher (no free seat, single-philosopher mode or not running)\n");
+            }
+        } else if (sig == SIGUSR2) {
+            int id = sim->max_philosophers - 1;
+            while (id >= 0 && remove_philosopher(sim, id) != 0) { // empty seats fail without side effects
+                --id;
+            }
+            if (id < 0) {
+                fprintf(stderr, "Notice: could not remove a philosopher (the ring stops at two or not running)\n");
+            }
+        }
+    }
+
+    return NULL;
+}
 
 int main (int argc, char *argv[]) {
     // DEFAULTS
     int num_philosophers = 5;
+    int max_philosophers = 0; // default: no spare seats (same as num_philosophers)
     int duration_seconds = 0; // default: run indefinitely
+    int retain_meals = 0;     // default: always put the hashi down after a meal
+    bool fair_mode = false;   // default: starving philosophers are forced to eat
+    workload_t workload;      // default: uniform think/eat/backoff times, no trace
+    init_workload(&workload);
+
+    // Every exit goes through `cleanup:` below, so anything allocated so far (histograms, trace, sim) gets freed
+    int rc = EXIT_FAILURE;
+    simulation_t *sim = NULL;
+    bool resize_mutex_ready = false;
+    resize_control_t control = { .sim = NULL };
+    pthread_t control_thread;
+    bool control_started = false;
 
     // FOR INPUT VERIFICATION
     long tmp = 0;   // we will check for min and max to be safe to downcast to `int`
@@ -37,58 +84,131 @@ int main (int argc, char *argv[]) {
             tmp = strtol(argv[++i], &endptr, /*base =*/ 10);
             if (errno != 0 || *endptr != '\0' || tmp <= 0 || tmp > INT_MAX) {
                 fprintf(stderr, "Invalid philosopher value: %s\n", argv[i]);
-                return EXIT_FAILURE;
+                goto cleanup;
             }
             num_philosophers = (int)tmp;
+        } else if (strcmp(argv[i], "--max-philosophers") == 0 && i + 1 < argc) {
+            tmp = strtol(argv[++i], &endptr, /*base =*/ 10);
+            if (errno != 0 || *endptr != '\0' || tmp <= 0 || tmp > INT_MAX) {
+                fprintf(stderr, "Invalid max-philosophers value: %s\n", argv[i]);
+                goto cleanup;
+            }
+            max_philosophers = (int)tmp;
         } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
             tmp = strtol(argv[++i], &endptr, /*base =*/ 10);
             if (errno != 0 || *endptr != '\0' || tmp < 0 || tmp > INT_MAX) {
                 fprintf(stderr, "Invalid duration value: %s\n", argv[i]);
-                return EXIT_FAILURE;
+                goto cleanup;
             }
             duration_seconds = (int)tmp;
+        } else if (strcmp(argv[i], "--retain-meals") == 0 && i + 1 < argc) {
+            tmp = strtol(argv[++i], &endptr, /*base =*/ 10);
+            if (errno != 0 || *endptr != '\0' || tmp < 0 || tmp > INT_MAX) {
+                fprintf(stderr, "Invalid retain-meals value: %s\n", argv[i]);
+                goto cleanup;
+            }
+            retain_meals = (int)tmp;
+        } else if (strcmp(argv[i], "--fair") == 0) {
+            fair_mode = true;
+        } else if ((strcmp(argv[i], "--think") == 0 || strcmp(argv[i], "--eat") == 0 || strcmp(argv[i], "--backoff") == 0) && i + 1 < argc) {
+            distribution_t *dist = (argv[i][2] == 't') ? &workload.think : (argv[i][2] == 'e') ? &workload.eat : &workload.backoff;
+            free_distribution(dist); // the flag may be given twice
+            if (parse_distribution(argv[i + 1], dist) != 0) {
+                fprintf(stderr, "Invalid %s value: %s\n", argv[i] + 2, argv[i + 1]);
+                goto cleanup;
+            }
+            ++i;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc && !workload.trace) {
+            if (load_trace(&workload, argv[++i]) != 0) {
+                fprintf(stderr, "Invalid trace value: %s\n", argv[i]);
+                goto cleanup;
+            }
         } else {
-            fprintf(stderr, "Usage: %s [--philosophers N] [--duration SECONDS]\n", argv[0]);
-            return EXIT_FAILURE;
+            fprintf(stderr, "Usage: %s [--philosophers N] [--max-philosophers N] [--duration SECONDS] [--retain-meals N] [--fair] "
+                            "[--think DIST] [--eat DIST] [--backoff DIST] [--trace FILE]\n"
+                            "  DIST: uniform:MIN,MAX | exp:MEAN | lognormal:MU,SIGMA | pareto:SCALE,ALPHA | hist:FILE (times in ms)\n"
+                            "  FILE for --trace: native-endian uint32 (think_ms, eat_ms) pairs, record i replayed by philosopher i %% N\n"
+                            "  While running: SIGUSR1 seats another philosopher (up to --max-philosophers), SIGUSR2 removes one (down to 2)\n",
+                    argv[0]);
+            goto cleanup;
         }
     }
 
-    // Allocate the overall simulation encapsulation context
-    simulation_t *sim = malloc(sizeof(simulation_t));
+    // Spare seats for SIGUSR1, the flags can come in any order so check them together
+    if (max_philosophers == 0) {
+        max_philosophers = num_philosophers;
+    } else if (max_philosophers < num_philosophers) {
+        fprintf(stderr, "Invalid max-philosophers value: %d (less than %d philosophers)\n", max_philosophers, num_philosophers);
+        goto cleanup;
+    }
+
+    // Allocate the overall simulation encapsulation context (zeroed, so cleanup can tell which arrays exist)
+    sim = calloc(1, sizeof(simulation_t));
     if (!sim) {
         fprintf(stderr, "ERROR: Failed to allocate for simulation\n");
-        return EXIT_FAILURE;
+        goto cleanup;
     }
 
     sim->num_philosophers = num_philosophers;
+    sim->max_philosophers = max_philosophers; // seats past num_philosophers stay empty until SIGUSR1
+    sim->retain_meals = retain_meals;
+    sim->workload = &workload;
+    sim->fair_mode = fair_mode;
     atomic_init(&sim->stop_flag, false);
 
     // Allocate the hashi(mutex) array
-    sim->hashi = malloc(sizeof(pthread_mutex_t) * sim->num_philosophers);
+    sim->hashi = malloc(sizeof(pthread_mutex_t) * sim->max_philosophers);
     if (!sim->hashi) {
         fprintf(stderr, "ERROR: Failed to allocate for hashi\n");
-        free(sim);
-
-        return EXIT_FAILURE;
+        goto cleanup;
     }
 
     // Allocate the philosophers(thread) array
-    sim->philosophers = malloc(sizeof(philosopher_t) * sim->num_philosophers);
+    sim->philosophers = malloc(sizeof(philosopher_t) * sim->max_philosophers);
     if (!sim->philosophers) {
         fprintf(stderr, "ERROR: Failed to allocate for philosophers\n");
-        free(sim->hashi);
-        free(sim);
+        goto cleanup;
+    }
 
-        return EXIT_FAILURE;
+    // Resize lock outlives the run, so add/remove_philosopher can tell we aren't running
+    if (init_resize_mutex(sim) != 0) {
+        goto cleanup;
     }
+    resize_mutex_ready = true;
+
+    // Block the resize signals before any thread starts (they inherit the mask), only the control thread waits for them
+    control.sim = sim;
+    atomic_init(&control.done, false);
+    sigemptyset(&control.signals);
+    sigaddset(&control.signals, SIGUSR1);
+    sigaddset(&control.signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &control.signals, NULL);
+    if (pthread_create(&control_thread, NULL, resize_control_routine, &control) != 0) {
+        fprintf(stderr, "ERROR: Failed to start the resize control thread\n");
+        goto cleanup;
+    }
+    control_started = true;
 
     // API Call
-    int rc = start_simulation(sim, duration_seconds);
+    rc = start_simulation(sim, duration_seconds);
+
+cleanup:
+    // The control thread may be mid add/remove_philosopher, those fail once the run is over, so stop it before freeing sim
+    if (control_started) {
+        atomic_store(&control.done, true);
+        pthread_join(control_thread, NULL);
+    }
 
     // Free memory after simulation ends -- we want callers responsible for their memory management
-    free(sim->philosophers);
-    free(sim->hashi);
-    free(sim);
+    if (sim) {
+        if (resize_mutex_ready) {
+            cleanup_resize_mutex(sim);
+        }
+        free(sim->philosophers);
+        free(sim->hashi);
+        free(sim);
+    }
+    free_workload(&workload);
 
     return rc;
 }
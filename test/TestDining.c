@@ -10,6 +10,7 @@
 #include <unistd.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdio.h>
 
 // cmocka API Documentation: https://api.cmocka.org/group__cmocka.html
 
@@ -32,16 +33,21 @@ static int setup_simulation(void **state) {
     assert_non_null(sim);
 
     sim->num_philosophers = 10;
+    sim->max_philosophers = 12; // a couple of spare seats for the resize tests
+    sim->retain_meals = 0;
+    sim->workload = NULL;
+    sim->fair_mode = false;
     atomic_init(&sim->stop_flag, false);
 
     // Allocate arrays for hashi and philosophers
-    sim->hashi = malloc(sizeof(pthread_mutex_t) * sim->num_philosophers);
+    sim->hashi = malloc(sizeof(pthread_mutex_t) * sim->max_philosophers);
     assert_non_null(sim->hashi);
 
-    sim->philosophers = malloc(sizeof(philosopher_t) * sim->num_philosophers);
+    sim->philosophers = malloc(sizeof(philosopher_t) * sim->max_philosophers);
     assert_non_null(sim->philosophers);
 
     // Initialize
+    assert_int_equal(init_resize_mutex(sim), 0);
     assert_int_equal(init_hashi(sim), 0);
     // If we run the simulation, this will get overwritten, so keep that in mind during tests that need to verify parts of the philosophers!
     assert_int_equal(init_philosophers(sim), 0);
@@ -54,6 +60,7 @@ static int teardown(void **state) {
     simulation_t *sim = *(simulation_t **)state;
 
     cleanup_hashi(sim);
+    cleanup_resize_mutex(sim);
 
     free(sim->philosophers);
     free(sim->hashi);
@@ -75,6 +82,12 @@ static void test_init_hashi_and_philosophers(void **state) {
         assert_ptr_equal(p->right_hashi, &sim->hashi[(i + 1) % sim->num_philosophers]);
         assert_int_equal(atomic_load(&p->state), THINKING);
         assert_int_equal(p->violation_flag, OK);
+        assert_true(p->seated);
+    }
+
+    // Spare seats are empty until someone joins
+    for (int i = sim->num_philosophers; i < sim->max_philosophers; ++i) {
+        assert_false(sim->philosophers[i].seated);
     }
 }
 
@@ -238,6 +251,291 @@ static void test_starving_philosopher_recovery(void **state) {
     }
 }
 
+static void test_add_and_remove_philosophers_while_running(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+
+    pthread_t thread_id;
+    struct sim_args args = {sim, 6};
+
+    // Nothing to resize before the simulation runs
+    assert_int_equal(add_philosopher(sim, 3), -1);
+    assert_int_equal(remove_philosopher(sim, 5), -1);
+
+    int rc = pthread_create(&thread_id, NULL, start_indefinite_wrapper, &args);
+    assert_int_equal(rc, 0);
+
+    // Give moment to start everything
+    sleep(1);
+
+    // Seat a new philosopher between 3 and 4, they take the first spare seat
+    int id = add_philosopher(sim, 3);
+    assert_int_equal(id, 10);
+    assert_int_equal(sim->num_philosophers, 11);
+    assert_ptr_equal(sim->philosophers[3].right_hashi, &sim->hashi[10]);
+    assert_ptr_equal(sim->philosophers[10].right_hashi, &sim->hashi[4]);
+    assert_ptr_equal(sim->philosophers[4].left_neighbor, &sim->philosophers[10]);
+
+    sleep(1);
+
+    // Remove philosopher 5, 4 now shares a hashi with 6
+    assert_int_equal(remove_philosopher(sim, 5), 0);
+    assert_int_equal(sim->num_philosophers, 10);
+    assert_ptr_equal(sim->philosophers[4].right_hashi, &sim->hashi[6]);
+    assert_ptr_equal(sim->philosophers[6].left_neighbor, &sim->philosophers[4]);
+
+    // Can't remove someone who already left
+    assert_int_equal(remove_philosopher(sim, 5), -1);
+
+    // The freed seat gets reused
+    assert_int_equal(add_philosopher(sim, 0), 5);
+    assert_int_equal(add_philosopher(sim, 0), 11);
+    // No more spare seats
+    assert_int_equal(add_philosopher(sim, 0), -1);
+
+    // Wait for this extra thread to finish
+    pthread_join(thread_id, NULL);
+
+    // ...or after it returned
+    assert_int_equal(add_philosopher(sim, 3), -1);
+    assert_int_equal(remove_philosopher(sim, 6), -1);
+
+    // Nobody ate next to an eating neighbor across the resizes
+    for (int i = 0; i < sim->max_philosophers; ++i) {
+        assert_int_equal(sim->philosophers[i].violation_flag, OK);
+    }
+}
+
+static void test_hashi_retention_without_violation(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+
+    // Keeping hashi must never let neighbors eat together or leave anyone starving
+    sim->num_philosophers = 3;
+    sim->retain_meals = 3;
+
+    assert_int_equal(start_simulation(sim, 5), 0);
+
+    for (int i = 0; i < sim->num_philosophers; ++i) {
+        assert_int_equal(sim->philosophers[i].violation_flag, OK);
+        assert_true(sim->philosophers[i].starvation_counter < 10);
+        assert_in_range(sim->philosophers[i].longest_meal_streak, 0, sim->retain_meals);
+    }
+}
+
+static void test_hashi_retention_at_low_contention(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+
+    // Long, spread out thinking and quick meals: neighbors are often not hungry, so hashi get kept
+    workload_t workload;
+    init_workload(&workload);
+    assert_int_equal(parse_distribution("exp:800", &workload.think), 0);
+    assert_int_equal(parse_distribution("uniform:5,10", &workload.eat), 0);
+    sim->workload = &workload;
+    sim->num_philosophers = 6;
+    sim->retain_meals = 2;
+
+    assert_int_equal(start_simulation(sim, 8), 0);
+
+    // Someone ate more than once per pickup, and nobody went past the cap
+    int longest = 0;
+    for (int i = 0; i < sim->num_philosophers; ++i) {
+        assert_int_equal(sim->philosophers[i].violation_flag, OK);
+        assert_in_range(sim->philosophers[i].longest_meal_streak, 0, sim->retain_meals);
+        if (sim->philosophers[i].longest_meal_streak > longest) {
+            longest = sim->philosophers[i].longest_meal_streak;
+        }
+    }
+    assert_int_equal(longest, sim->retain_meals);
+
+    sim->workload = NULL;
+    free_workload(&workload);
+}
+
+static void test_default_workload_ranges(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+    philosopher_t *p = &sim->philosophers[0];
+
+    // Same ranges the old hard-coded rand() calls used, across several batch refills
+    for (int i = 0; i < WORKLOAD_BATCH * 4; ++i) {
+        assert_in_range(next_think_ms(p), 500, 1499);
+        assert_in_range(next_eat_ms(p), 500, 1499);
+        assert_in_range(next_backoff_ms(p), 50, 149);
+    }
+}
+
+static void test_parse_and_sample_distributions(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+    philosopher_t *p = &sim->philosophers[0];
+
+    workload_t workload;
+    init_workload(&workload);
+    sim->workload = &workload;
+
+    // Bad specs are rejected
+    assert_int_not_equal(parse_distribution("exp:", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("exp:-5", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("uniform:10,5", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("pareto:100,2junk", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("gamma:1,2", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("hist:/nonexistent/histogram", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("exp:nan", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("uniform:0,inf", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("lognormal:nan,1", &workload.think), 0);
+    assert_int_not_equal(parse_distribution("pareto:inf,2", &workload.think), 0);
+
+    // Exponential mean lands close to the configured one
+    assert_int_equal(parse_distribution("exp:200", &workload.think), 0);
+    assert_int_equal(workload.think.kind, DIST_EXPONENTIAL);
+    long total = 0;
+    for (int i = 0; i < 20000; ++i) {
+        total += next_think_ms(p);
+    }
+    assert_in_range(total / 20000, 180, 220);
+
+    // Pareto never goes below its scale, and the tail is capped
+    assert_int_equal(parse_distribution("pareto:100,1.1", &workload.eat), 0);
+    for (int i = 0; i < 20000; ++i) {
+        assert_in_range(next_eat_ms(p), 100, WORKLOAD_MAX_MS);
+    }
+
+    // Lognormal with sigma 0 is a constant e^mu
+    assert_int_equal(parse_distribution("lognormal:5,0", &workload.backoff), 0);
+    for (int i = 0; i < WORKLOAD_BATCH * 2; ++i) {
+        assert_in_range(next_backoff_ms(p), 147, 148); // e^5 = 148.41
+    }
+
+    sim->workload = NULL;
+    free_workload(&workload);
+}
+
+static void test_histogram_and_trace_workload(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+    philosopher_t *p = &sim->philosophers[1];
+
+    char hist_path[] = "/tmp/dining_histXXXXXX";
+    int fd = mkstemp(hist_path);
+    assert_true(fd >= 0);
+    FILE *f = fdopen(fd, "w");
+    fprintf(f, "100 1\n250 3\n");
+    fclose(f);
+
+    // Non-finite weights are rejected
+    char bad_hist_path[] = "/tmp/dining_histXXXXXX";
+    fd = mkstemp(bad_hist_path);
+    assert_true(fd >= 0);
+    f = fdopen(fd, "w");
+    fprintf(f, "100 1\n250 nan\n");
+    fclose(f);
+
+    // 2 records per seat, so philosopher 1 gets records 1 and 13 before wrapping
+    char trace_path[] = "/tmp/dining_traceXXXXXX";
+    fd = mkstemp(trace_path);
+    assert_true(fd >= 0);
+    f = fdopen(fd, "wb");
+    for (uint32_t i = 0; i < 24; ++i) {
+        uint32_t record[2] = {1000 + i, 2000 + i};
+        fwrite(record, sizeof(record), 1, f);
+    }
+    fclose(f);
+
+    workload_t workload;
+    init_workload(&workload);
+    assert_int_equal(parse_distribution(hist_path, &workload.backoff), -1); // needs the hist: prefix
+    char spec[64];
+    snprintf(spec, sizeof(spec), "hist:%s", bad_hist_path);
+    assert_int_equal(parse_distribution(spec, &workload.backoff), -1);
+    unlink(bad_hist_path);
+    snprintf(spec, sizeof(spec), "hist:%s", hist_path);
+    assert_int_equal(parse_distribution(spec, &workload.backoff), 0);
+    assert_int_equal(workload.backoff.histogram_size, 2);
+    assert_int_equal(load_trace(&workload, trace_path), 0);
+    assert_int_equal(workload.trace_records, 24);
+    sim->workload = &workload;
+
+    // Only histogram buckets come out
+    for (int i = 0; i < WORKLOAD_BATCH * 2; ++i) {
+        int ms = next_backoff_ms(p);
+        assert_true(ms == 100 || ms == 250);
+    }
+
+    // A meal cycle takes think and eat from the same record, a failed attempt thinks again on it without moving on
+    assert_int_equal(next_think_ms(p), 1001);
+    assert_int_equal(next_think_ms(p), 1001); // failed attempt
+    assert_int_equal(next_eat_ms(p), 2001);
+    assert_int_equal(next_think_ms(p), 1013);
+    assert_int_equal(next_eat_ms(p), 2013);
+    assert_int_equal(next_think_ms(p), 1001); // wrapped around
+    assert_int_equal(next_think_ms(p), 1001); // failed attempt
+    assert_int_equal(next_think_ms(p), 1001); // failed attempt
+    assert_int_equal(next_eat_ms(p), 2001);
+    assert_int_equal(next_think_ms(p), 1013);
+
+    sim->workload = NULL;
+    free_workload(&workload);
+    assert_null(workload.trace);
+    unlink(hist_path);
+    unlink(trace_path);
+}
+
+static void test_fair_mode_without_forced_meals(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+
+    sim->fair_mode = true;
+    assert_int_equal(start_simulation(sim, 6), 0);
+
+    // Nobody ate next to an eating neighbor
+    for (int i = 0; i < sim->num_philosophers; ++i) {
+        assert_int_equal(sim->philosophers[i].violation_flag, OK);
+    }
+
+    // Meals were recorded
+    assert_true(total_meals(sim) > 0);
+    assert_int_not_equal(hunger_latency_percentile(sim, 50.0), -1);
+}
+
+static void test_fair_mode_bounds_skipped_meals(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+
+    // Near-zero think/eat times so hungers overlap constantly (and often start in the same millisecond)
+    workload_t workload;
+    init_workload(&workload);
+    assert_int_equal(parse_distribution("uniform:0,2", &workload.think), 0);
+    assert_int_equal(parse_distribution("uniform:0,2", &workload.eat), 0);
+    assert_int_equal(parse_distribution("uniform:0,2", &workload.backoff), 0);
+    sim->workload = &workload;
+    sim->fair_mode = true;
+
+    assert_int_equal(start_simulation(sim, 3), 0);
+
+    // While hungry, each of our two neighbors starts at most one more meal
+    for (int i = 0; i < sim->num_philosophers; ++i) {
+        assert_in_range(sim->philosophers[i].most_meals_skipped, 0, 2);
+    }
+
+    sim->workload = NULL;
+    free_workload(&workload);
+}
+
+static void test_hunger_latency_percentiles(void **state) {
+    simulation_t *sim = * (simulation_t **)state;
+
+    for (int i = 0; i < HUNGER_BUCKETS; ++i) {
+        atomic_store(&sim->hunger_histogram[i], 0);
+    }
+    assert_int_equal(total_meals(sim), 0);
+    assert_int_equal(hunger_latency_percentile(sim, 50.0), -1);
+
+    // 998 quick meals, one slow one and one very slow one
+    atomic_store(&sim->hunger_histogram[0], 998);
+    atomic_store(&sim->hunger_histogram[50], 1);
+    atomic_store(&sim->hunger_histogram[HUNGER_BUCKETS - 1], 1);
+
+    assert_int_equal(total_meals(sim), 1000);
+    assert_int_equal(hunger_latency_percentile(sim, 50.0), HUNGER_BUCKET_MS);
+    assert_int_equal(hunger_latency_percentile(sim, 99.8), HUNGER_BUCKET_MS);
+    assert_int_equal(hunger_latency_percentile(sim, 99.9), 51 * HUNGER_BUCKET_MS);
+    assert_int_equal(hunger_latency_percentile(sim, 100.0), HUNGER_BUCKETS * HUNGER_BUCKET_MS);
+}
+
 /*============== Test Runner ==============*/
 int main(void) {
     const struct CMUnitTest tests[] = {
@@ -250,7 +548,16 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_start_simulation_with_invalid_philosohpers, setup_simulation, teardown),
         cmocka_unit_test_setup_teardown(test_start_indefinite_simulation_and_enable_stop_flag, setup_simulation, teardown),
         cmocka_unit_test_setup_teardown(test_violation_during_philosopher_routine, setup_simulation, teardown),
-        cmocka_unit_test_setup_teardown(test_starving_philosopher_recovery, setup_simulation, teardown)
+        cmocka_unit_test_setup_teardown(test_starving_philosopher_recovery, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_add_and_remove_philosophers_while_running, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_hashi_retention_without_violation, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_hashi_retention_at_low_contention, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_default_workload_ranges, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_parse_and_sample_distributions, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_histogram_and_trace_workload, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_fair_mode_without_forced_meals, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_fair_mode_bounds_skipped_meals, setup_simulation, teardown),
+        cmocka_unit_test_setup_teardown(test_hunger_latency_percentiles, setup_simulation, teardown)
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }